@@ -0,0 +1,64 @@
+#include "AsyncImageWriter.hpp"
+#include <opencv2/opencv.hpp>
+
+using namespace cv;
+using namespace std;
+
+AsyncImageWriter::AsyncImageWriter() {
+    // Started here so every other member is constructed before the thread runs
+    worker_ = thread(&AsyncImageWriter::run, this);
+}
+
+AsyncImageWriter::~AsyncImageWriter() {
+    finish();
+}
+
+void AsyncImageWriter::enqueue(const string& path, Mat image) {
+    {
+        lock_guard<mutex> lock(mutex_);
+        queue_.emplace_back(path, std::move(image));
+    }
+    ready_.notify_one();
+}
+
+int AsyncImageWriter::finish() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_one();
+
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+
+    return failures_;
+}
+
+void AsyncImageWriter::run() {
+    while (true) {
+        pair<string, Mat> job;
+        {
+            unique_lock<mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+
+            // Drain the queue before honouring a stop request
+            if (queue_.empty()) {
+                return;
+            }
+
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        // Encode outside the lock so the carving thread can keep queueing
+        if (!imwrite(job.first, job.second)) {
+            cerr << "Error: Could not write " << job.first << endl;
+            lock_guard<mutex> lock(mutex_);
+            failures_++;
+        }
+        else {
+            cout << "Wrote " << job.first << " (" << job.second.cols << "x" << job.second.rows << ")" << endl;
+        }
+    }
+}
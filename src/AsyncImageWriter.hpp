@@ -0,0 +1,40 @@
+#ifndef ASYNC_IMAGE_WRITER_HPP
+#define ASYNC_IMAGE_WRITER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+// Writes images on a background thread so encoding overlaps with carving.
+// Queued images are owned by the writer until they have been written.
+class AsyncImageWriter {
+public:
+    AsyncImageWriter();
+    ~AsyncImageWriter();
+
+    AsyncImageWriter(const AsyncImageWriter&) = delete;
+    AsyncImageWriter& operator=(const AsyncImageWriter&) = delete;
+
+    // Queue an image for writing; the writer takes ownership of the Mat
+    void enqueue(const std::string& path, cv::Mat image);
+
+    // Wait until every queued image is written and stop the thread.
+    // Returns the number of images that failed to write.
+    int finish();
+
+private:
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::pair<std::string, cv::Mat>> queue_;
+    bool stopping_ = false;
+    int failures_ = 0;
+
+    void run();
+};
+
+#endif
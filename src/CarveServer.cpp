@@ -0,0 +1,415 @@
+#include "CarveServer.hpp"
+#include "SeamCarver.hpp"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+vector<string> tokenize(const string& line) {
+    vector<string> tokens;
+    istringstream stream(line);
+    string token;
+    while (stream >> token) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+bool parseInt(const string& text, int& value) {
+    char* end = nullptr;
+    long parsed = strtol(text.c_str(), &end, 10);
+    if (end == text.c_str() || *end != '\0') {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+string hitRate(size_t hits, size_t misses) {
+    size_t total = hits + misses;
+    double rate = total > 0 ? static_cast<double>(hits) / total : 0.0;
+    return format("%.3f(%zu/%zu)", rate, hits, total);
+}
+
+}  // namespace
+
+CarveServer::CarveServer(size_t cacheBytes) : cacheBytes_(cacheBytes) {
+    latencies_.reserve(LATENCY_WINDOW);
+}
+
+int CarveServer::run(istream& in, ostream& out) {
+    out << "READY" << endl;
+
+    string line;
+    while (getline(in, line)) {
+        vector<string> tokens = tokenize(line);
+        if (tokens.empty()) {
+            continue;
+        }
+
+        string command = tokens[0];
+        transform(command.begin(), command.end(), command.begin(),
+            [](unsigned char c) { return static_cast<char>(toupper(c)); });
+
+        if (command == "QUIT") {
+            out << "OK bye" << endl;
+            break;
+        }
+
+        out << handleRequest(line) << endl;
+    }
+
+    return 0;
+}
+
+string CarveServer::handleRequest(const string& line) {
+    vector<string> tokens = tokenize(line);
+    if (tokens.empty()) {
+        return "ERR empty request";
+    }
+
+    string command = tokens[0];
+    transform(command.begin(), command.end(), command.begin(),
+        [](unsigned char c) { return static_cast<char>(toupper(c)); });
+
+    if (command == "STATS") {
+        return handleStats();
+    }
+
+    auto start = chrono::steady_clock::now();
+    string response;
+
+    if (command == "CARVE") {
+        response = handleCarve(tokens);
+    }
+    else if (command == "ENERGY") {
+        response = handleEnergy(tokens);
+    }
+    else {
+        response = "ERR unknown command: " + tokens[0];
+    }
+
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    recordLatency(ms);
+    requests_++;
+    if (usedBytes_ > cacheBytes_) {
+        overBudget_++;
+    }
+
+    if (response.compare(0, 3, "ERR") == 0) {
+        errors_++;
+        return response;
+    }
+
+    return response + format(" %.2fms", ms);
+}
+
+// ============================================================================
+// REQUEST HANDLERS
+// ============================================================================
+
+string CarveServer::handleCarve(const vector<string>& args) {
+    int width = 0;
+    int height = 0;
+
+    if (args.size() != 5 || !parseInt(args[3], width) || !parseInt(args[4], height)) {
+        return "ERR usage: CARVE <input> <output> <width> <height>";
+    }
+
+    string error;
+    CacheEntry* entry = loadSource(args[1], error);
+    if (entry == nullptr) {
+        return "ERR " + error;
+    }
+
+    const Mat& source = entry->image;
+    if (width <= 0 || height <= 0 || width > source.cols || height > source.rows) {
+        return format("ERR target %dx%d must be within source size %dx%d",
+            width, height, source.cols, source.rows);
+    }
+
+    // Width: compact the source with its vertical seam index map
+    int column_seams = source.cols - width;
+    string column_status = "none";
+    Mat result = source;
+
+    if (column_seams > 0) {
+        // A fresh map starts from the source energy: share it with ENERGY
+        Mat start_energy;
+        if (entry->columns.depth == 0) {
+            fillEnergy(*entry);
+            start_energy = entry->energy;
+        }
+
+        bool hit = fillSeamOrder(*entry, entry->columns, source, column_seams, start_energy);
+        column_status = hit ? "hit" : "miss";
+        if (hit) {
+            columnOrderHits_++;
+        }
+        else {
+            columnOrderMisses_++;
+        }
+
+        result = SeamCarver::applyVerticalSeamOrder(source, entry->columns.order, width);
+        if (result.empty()) {
+            return "ERR failed to apply seam order map";
+        }
+    }
+
+    // Height: the same index map on the transposed width-reduced image
+    int row_seams = result.rows - height;
+    string row_status = "none";
+
+    if (row_seams > 0) {
+        SeamOrder& rows_order = rowOrder(*entry, width);
+
+        Mat transposed;
+        transpose(result, transposed);
+
+        // The energy of a transposed image is the transposed energy map
+        Mat start_energy;
+        if (column_seams == 0 && rows_order.depth == 0) {
+            fillEnergy(*entry);
+            transpose(entry->energy, start_energy);
+        }
+
+        bool hit = fillSeamOrder(*entry, rows_order, transposed, row_seams, start_energy);
+        row_status = hit ? "hit" : "miss";
+        if (hit) {
+            rowOrderHits_++;
+        }
+        else {
+            rowOrderMisses_++;
+        }
+
+        Mat carved = SeamCarver::applyVerticalSeamOrder(transposed, rows_order.order, height);
+        if (carved.empty()) {
+            return "ERR failed to apply seam order map";
+        }
+        transpose(carved, result);
+    }
+
+    if (!imwrite(args[2], result)) {
+        return "ERR could not write " + args[2];
+    }
+
+    return format("OK %dx%d columns=%s rows=%s", result.cols, result.rows,
+        column_status.c_str(), row_status.c_str());
+}
+
+string CarveServer::handleEnergy(const vector<string>& args) {
+    if (args.size() != 3) {
+        return "ERR usage: ENERGY <input> <output>";
+    }
+
+    string error;
+    CacheEntry* entry = loadSource(args[1], error);
+    if (entry == nullptr) {
+        return "ERR " + error;
+    }
+
+    string energy_status = fillEnergy(*entry) ? "hit" : "miss";
+
+    // Same rendering as the interactive energy view
+    Mat energy_normalized;
+    normalize(entry->energy, energy_normalized, 0, 255, NORM_MINMAX);
+    energy_normalized.convertTo(energy_normalized, CV_8U);
+
+    Mat energy_color;
+    applyColorMap(energy_normalized, energy_color, COLORMAP_JET);
+
+    if (!imwrite(args[2], energy_color)) {
+        return "ERR could not write " + args[2];
+    }
+
+    return "OK energy=" + energy_status;
+}
+
+string CarveServer::handleStats() const {
+    return format("STATS requests=%zu errors=%zu entries=%zu cache_bytes=%zu/%zu evictions=%zu "
+        "row_order_evictions=%zu over_budget=%zu "
+        "image_hit_rate=%s energy_hit_rate=%s column_order_hit_rate=%s row_order_hit_rate=%s "
+        "p50_ms=%.2f p90_ms=%.2f p99_ms=%.2f",
+        requests_, errors_, cache_.size(), usedBytes_, cacheBytes_, evictions_,
+        rowOrderEvictions_, overBudget_,
+        hitRate(imageHits_, imageMisses_).c_str(),
+        hitRate(energyHits_, energyMisses_).c_str(),
+        hitRate(columnOrderHits_, columnOrderMisses_).c_str(),
+        hitRate(rowOrderHits_, rowOrderMisses_).c_str(),
+        latencyPercentile(0.50), latencyPercentile(0.90), latencyPercentile(0.99));
+}
+
+// ============================================================================
+// CACHE
+// ============================================================================
+
+CarveServer::CacheEntry* CarveServer::loadSource(const string& path, string& error) {
+    ifstream file(path, ios::binary);
+    if (!file) {
+        error = "could not open " + path;
+        return nullptr;
+    }
+
+    vector<unsigned char> bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    uint64_t key = hashBytes(bytes);
+
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+        imageHits_++;
+        touch(key, it->second);
+        return &it->second;
+    }
+
+    imageMisses_++;
+
+    Mat image = imdecode(bytes, IMREAD_COLOR);
+    if (image.empty()) {
+        error = "could not decode " + path;
+        return nullptr;
+    }
+
+    CacheEntry& entry = cache_[key];
+    entry.image = image;
+    lru_.push_front(key);
+    entry.lruPos = lru_.begin();
+    usedBytes_ += entryBytes(entry);
+    evict(key);
+
+    return &entry;
+}
+
+bool CarveServer::fillSeamOrder(CacheEntry& entry, SeamOrder& order, const Mat& image, int seams,
+    const Mat& startEnergy) {
+    if (order.depth >= seams) {
+        return true;
+    }
+
+    // Deeper carve than anything cached: extend the index map from the
+    // cached depth so the steps already recorded aren't recomputed
+    usedBytes_ -= entryBytes(entry);
+
+    // Header copy: the carver shares the image without cloning
+    SeamCarver carver{Mat(image)};
+    order.order = carver.computeVerticalSeamOrder(seams, order.order, order.depth, startEnergy);
+    order.depth = order.order.empty() ? 0 : seams;
+
+    usedBytes_ += entryBytes(entry);
+    evict(*entry.lruPos);
+    return false;
+}
+
+bool CarveServer::fillEnergy(CacheEntry& entry) {
+    if (!entry.energy.empty()) {
+        energyHits_++;
+        return true;
+    }
+
+    energyMisses_++;
+    usedBytes_ -= entryBytes(entry);
+    entry.energy = SeamCarver::computeEnergyMap(entry.image);
+    usedBytes_ += entryBytes(entry);
+    evict(*entry.lruPos);
+    return false;
+}
+
+CarveServer::SeamOrder& CarveServer::rowOrder(CacheEntry& entry, int width) {
+    for (auto it = entry.rows.begin(); it != entry.rows.end(); ++it) {
+        if (it->first == width) {
+            entry.rows.splice(entry.rows.begin(), entry.rows, it);
+            return entry.rows.front().second;
+        }
+    }
+
+    entry.rows.emplace_front(width, SeamOrder());
+    return entry.rows.front().second;
+}
+
+void CarveServer::touch(uint64_t key, CacheEntry& entry) {
+    lru_.erase(entry.lruPos);
+    lru_.push_front(key);
+    entry.lruPos = lru_.begin();
+}
+
+void CarveServer::evict(uint64_t keepKey) {
+    // Horizontal maps go first: each one only serves a single width. The front
+    // map of the source in use may belong to the current request, so it stays.
+    for (auto key = lru_.rbegin(); key != lru_.rend() && usedBytes_ > cacheBytes_; ++key) {
+        CacheEntry& entry = cache_.find(*key)->second;
+        size_t keep = *key == keepKey ? 1 : 0;
+
+        while (usedBytes_ > cacheBytes_ && entry.rows.size() > keep) {
+            const Mat& order = entry.rows.back().second.order;
+            usedBytes_ -= order.total() * order.elemSize();
+            entry.rows.pop_back();
+            rowOrderEvictions_++;
+        }
+    }
+
+    // Then drop least recently used sources until we fit, never the one in use
+    while (usedBytes_ > cacheBytes_ && !lru_.empty() && lru_.back() != keepKey) {
+        uint64_t victim = lru_.back();
+        lru_.pop_back();
+
+        auto it = cache_.find(victim);
+        usedBytes_ -= entryBytes(it->second);
+        cache_.erase(it);
+        evictions_++;
+    }
+}
+
+size_t CarveServer::entryBytes(const CacheEntry& entry) {
+    size_t bytes = entry.image.total() * entry.image.elemSize()
+        + entry.energy.total() * entry.energy.elemSize()
+        + entry.columns.order.total() * entry.columns.order.elemSize();
+    for (const auto& rows : entry.rows) {
+        bytes += rows.second.order.total() * rows.second.order.elemSize();
+    }
+    return bytes;
+}
+
+uint64_t CarveServer::hashBytes(const vector<unsigned char>& bytes) {
+    // 64-bit FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char byte : bytes) {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// ============================================================================
+// LATENCY TRACKING
+// ============================================================================
+
+void CarveServer::recordLatency(double ms) {
+    if (latencies_.size() < LATENCY_WINDOW) {
+        latencies_.push_back(ms);
+    }
+    else {
+        latencies_[latencyNext_] = ms;
+    }
+    latencyNext_ = (latencyNext_ + 1) % LATENCY_WINDOW;
+}
+
+double CarveServer::latencyPercentile(double p) const {
+    if (latencies_.empty()) {
+        return 0.0;
+    }
+
+    vector<double> sorted = latencies_;
+    sort(sorted.begin(), sorted.end());
+
+    size_t index = static_cast<size_t>(ceil(p * sorted.size()));
+    index = index > 0 ? index - 1 : 0;
+    return sorted[min(index, sorted.size() - 1)];
+}
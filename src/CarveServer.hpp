@@ -0,0 +1,111 @@
+#ifndef CARVE_SERVER_HPP
+#define CARVE_SERVER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <iostream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Long-running carving service driven by a line protocol on stdin/stdout.
+//
+// Requests (one per line, whitespace separated, paths must not contain spaces):
+//   CARVE <input> <output> <width> <height>   carve input down to width x height
+//   ENERGY <input> <output>                   write the colour-mapped energy map
+//   STATS                                     cache hit rates and latency percentiles
+//   QUIT                                      stop the server
+//
+// Every request gets exactly one response line starting with OK, STATS or ERR.
+//
+// Sources are keyed by a hash of their file contents. Decoded images, energy
+// maps and seam index maps are kept in an LRU cache bounded by cacheBytes. The
+// vertical map serves every width of a source, so a new width only compacts
+// (or extends the map when it is narrower than any before). The horizontal map
+// is built by a full carve of the width-reduced image and only serves later
+// requests with that same width. The energy map is shared by ENERGY and by the
+// first step of a fresh seam index map.
+//
+// When the cache is over budget, horizontal maps are evicted first (least
+// recently used source first, keeping the one the current request uses), then
+// whole sources. A single source that still doesn't fit stays cached and is
+// counted as over budget in STATS.
+class CarveServer {
+public:
+    explicit CarveServer(size_t cacheBytes = 512u * 1024u * 1024u);
+
+    // Process requests until QUIT or end of input
+    int run(std::istream& in, std::ostream& out);
+
+    // Handle a single request line and return the response line
+    std::string handleRequest(const std::string& line);
+
+private:
+    struct SeamOrder {
+        cv::Mat order;              // CV_32S removal step per pixel (see SeamCarver)
+        int depth = 0;              // number of seams recorded in order
+    };
+
+    struct CacheEntry {
+        cv::Mat image;
+        cv::Mat energy;
+        SeamOrder columns;          // vertical seams of the source
+        // Horizontal seams, built on the transposed image after the width has
+        // been reduced, keyed by that intermediate width; most recently used first
+        std::list<std::pair<int, SeamOrder>> rows;
+        std::list<uint64_t>::iterator lruPos;
+    };
+
+    size_t cacheBytes_;
+    size_t usedBytes_ = 0;
+    std::list<uint64_t> lru_;       // most recently used first
+    std::unordered_map<uint64_t, CacheEntry> cache_;
+
+    // Counters reported by STATS
+    size_t requests_ = 0;
+    size_t errors_ = 0;
+    size_t imageHits_ = 0;
+    size_t imageMisses_ = 0;
+    size_t energyHits_ = 0;
+    size_t energyMisses_ = 0;
+    size_t columnOrderHits_ = 0;
+    size_t columnOrderMisses_ = 0;
+    size_t rowOrderHits_ = 0;
+    size_t rowOrderMisses_ = 0;
+    size_t evictions_ = 0;
+    size_t rowOrderEvictions_ = 0;
+    size_t overBudget_ = 0;         // requests that left the cache over budget
+
+    // Ring buffer of the most recent request latencies in milliseconds
+    static constexpr size_t LATENCY_WINDOW = 1024;
+    std::vector<double> latencies_;
+    size_t latencyNext_ = 0;
+
+    std::string handleCarve(const std::vector<std::string>& args);
+    std::string handleEnergy(const std::vector<std::string>& args);
+    std::string handleStats() const;
+
+    // Load (or fetch from cache) the source at path; returns nullptr on failure
+    CacheEntry* loadSource(const std::string& path, std::string& error);
+
+    // Make sure entry.energy is filled (and accounted for); returns true on a cache hit
+    bool fillEnergy(CacheEntry& entry);
+
+    // Extend order to at least `seams` vertical seams of image; returns true on a cache hit
+    bool fillSeamOrder(CacheEntry& entry, SeamOrder& order, const cv::Mat& image, int seams,
+        const cv::Mat& startEnergy);
+
+    // Find or create the horizontal map for width and mark it most recently used
+    static SeamOrder& rowOrder(CacheEntry& entry, int width);
+
+    void touch(uint64_t key, CacheEntry& entry);
+    void evict(uint64_t keepKey);
+    void recordLatency(double ms);
+    double latencyPercentile(double p) const;
+
+    static size_t entryBytes(const CacheEntry& entry);
+    static uint64_t hashBytes(const std::vector<unsigned char>& bytes);
+};
+
+#endif
@@ -0,0 +1,233 @@
+#include "HybridRetargeter.hpp"
+#include "SeamCarver.hpp"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+// Longest side of the probe images used for planning
+const int COST_PROBE_SIZE = 512;
+const int ENERGY_PROBE_SIZE = 256;
+const int COST_PROBE_SEAMS = 3;
+
+Mat downscaleTo(const Mat& image, int longest_side) {
+    double scale = static_cast<double>(longest_side) / max(image.cols, image.rows);
+    if (scale >= 1.0) {
+        return image;
+    }
+
+    Mat probe;
+    resize(image, probe, Size(max(2, cvRound(image.cols * scale)), max(2, cvRound(image.rows * scale))),
+        0, 0, INTER_AREA);
+    return probe;
+}
+
+// Largest k such that k seams are at most `fraction` of the carved width (target + k)
+int seamsForFraction(double fraction, int target, int reduction) {
+    if (fraction >= 1.0) {
+        return reduction;
+    }
+    int seams = static_cast<int>(floor(fraction * target / (1.0 - fraction)));
+    return max(0, min(seams, reduction));
+}
+
+}  // namespace
+
+HybridRetargeter::HybridRetargeter(const Options& options) : options_(options) {
+}
+
+Mat HybridRetargeter::retarget(const Mat& image, const Size& target, Report* report) const {
+    auto start = chrono::steady_clock::now();
+
+    if (image.empty()) {
+        cerr << "Error: Cannot retarget an empty image!" << endl;
+        return Mat();
+    }
+
+    if (target.width <= 0 || target.height <= 0
+        || target.width > image.cols || target.height > image.rows) {
+        cerr << "Error: Target size " << target.width << "x" << target.height
+            << " must be within image size " << image.cols << "x" << image.rows << "!" << endl;
+        return Mat();
+    }
+
+    // Without a limit every seam would be carved at full resolution, which is
+    // exactly what this mode exists to avoid
+    if (options_.timeBudgetMs <= 0.0 && options_.maxSeamEnergy <= 0.0) {
+        cerr << "Error: Hybrid retargeting needs a time budget or an energy limit!" << endl;
+        return Mat();
+    }
+
+    int reduce_cols = image.cols - target.width;
+    int reduce_rows = image.rows - target.height;
+
+    // Energy limit: carve only the seams that are cheap on a low-res probe
+    int max_vertical = reduce_cols;
+    int max_horizontal = reduce_rows;
+
+    if (options_.maxSeamEnergy > 0.0) {
+        Mat probe = downscaleTo(image, ENERGY_PROBE_SIZE);
+        if (reduce_cols > 0) {
+            max_vertical = seamsForFraction(cheapSeamFraction(probe, true), target.width, reduce_cols);
+        }
+        if (reduce_rows > 0) {
+            max_horizontal = seamsForFraction(cheapSeamFraction(probe, false), target.height, reduce_rows);
+        }
+    }
+
+    // Time limit: shrink both seam counts by the same factor until the cost
+    // model fits the budget
+    // The cost probe is only needed for the budget or for the report
+    double cost_per_pixel = 0.0;
+    if (options_.timeBudgetMs > 0.0 || report != nullptr) {
+        cost_per_pixel = measureCostPerPixelMs(image);
+    }
+
+    int vertical_seams = max_vertical;
+    int horizontal_seams = max_horizontal;
+
+    if (options_.timeBudgetMs > 0.0
+        && estimateCarveMs(cost_per_pixel, target, vertical_seams, horizontal_seams) > options_.timeBudgetMs) {
+        double low = 0.0;
+        double high = 1.0;
+        for (int iter = 0; iter < 30; iter++) {
+            double mid = (low + high) / 2;
+            int v = static_cast<int>(max_vertical * mid);
+            int h = static_cast<int>(max_horizontal * mid);
+            if (estimateCarveMs(cost_per_pixel, target, v, h) <= options_.timeBudgetMs) {
+                low = mid;
+            }
+            else {
+                high = mid;
+            }
+        }
+        vertical_seams = static_cast<int>(max_vertical * low);
+        horizontal_seams = static_cast<int>(max_horizontal * low);
+    }
+
+    // Uniform scaling takes the part of the reduction we don't carve
+    Size scaled(target.width + vertical_seams, target.height + horizontal_seams);
+    Mat working;
+    if (scaled.width != image.cols || scaled.height != image.rows) {
+        resize(image, working, scaled, 0, 0, INTER_AREA);
+    }
+    else {
+        working = image;
+    }
+
+    SeamCarver carver(std::move(working));
+
+    for (int i = 0; i < vertical_seams; i++) {
+        vector<int> seam = carver.findVerticalSeamDP();
+        if (seam.empty()) {
+            break;
+        }
+        carver.removeVerticalSeam(seam);
+    }
+
+    for (int i = 0; i < horizontal_seams; i++) {
+        vector<int> seam = carver.findHorizontalSeamDP();
+        if (seam.empty()) {
+            break;
+        }
+        carver.removeHorizontalSeam(seam);
+    }
+
+    Mat result = carver.release();
+
+    if (report != nullptr) {
+        report->sourceSize = image.size();
+        report->scaledSize = scaled;
+        report->targetSize = target;
+        report->verticalSeams = vertical_seams;
+        report->horizontalSeams = horizontal_seams;
+        report->elapsedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        report->estimatedFullCarveMs = estimateCarveMs(cost_per_pixel, target, reduce_cols, reduce_rows);
+        report->timeSavedMs = max(0.0, report->estimatedFullCarveMs - report->elapsedMs);
+    }
+
+    return result;
+}
+
+// ============================================================================
+// PLANNING HELPERS
+// ============================================================================
+
+double HybridRetargeter::measureCostPerPixelMs(const Mat& image) {
+    SeamCarver carver(downscaleTo(image, COST_PROBE_SIZE));
+
+    double pixels = 0.0;
+    auto start = chrono::steady_clock::now();
+
+    for (int i = 0; i < COST_PROBE_SEAMS && carver.getWidth() > 1; i++) {
+        pixels += static_cast<double>(carver.getWidth()) * carver.getHeight();
+        vector<int> seam = carver.findVerticalSeamDP();
+        if (seam.empty()) {
+            break;
+        }
+        carver.removeVerticalSeam(seam);
+    }
+
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return pixels > 0.0 ? ms / pixels : 0.0;
+}
+
+double HybridRetargeter::cheapSeamFraction(const Mat& probe, bool vertical) const {
+    SeamCarver carver{Mat(probe)};
+    Mat start_energy = carver.energyView();
+    if (start_energy.empty()) {
+        return 0.0;
+    }
+
+    double limit = mean(start_energy)[0] * options_.maxSeamEnergy;
+    int length = vertical ? carver.getWidth() : carver.getHeight();
+    int cheap = 0;
+
+    while (cheap < length - 1) {
+        Mat energy = carver.energyView();
+        vector<int> seam = vertical
+            ? SeamCarver::findVerticalSeamInEnergy(energy, 0, energy.cols)
+            : SeamCarver::findHorizontalSeamInEnergy(energy, 0, energy.rows);
+        if (seam.empty()) {
+            break;
+        }
+
+        // Mean energy along the seam
+        double seam_energy = 0.0;
+        for (int k = 0; k < seam.size(); k++) {
+            seam_energy += vertical ? energy.at<float>(k, seam[k]) : energy.at<float>(seam[k], k);
+        }
+        seam_energy /= seam.size();
+
+        if (seam_energy > limit) {
+            break;
+        }
+
+        if (vertical) {
+            carver.removeVerticalSeam(seam);
+        }
+        else {
+            carver.removeHorizontalSeam(seam);
+        }
+        cheap++;
+    }
+
+    return static_cast<double>(cheap) / length;
+}
+
+double HybridRetargeter::estimateCarveMs(double costPerPixelMs, const Size& target, int verticalSeams, int horizontalSeams) {
+    // Vertical seams run first at the scaled height, each one on a frame one
+    // column narrower; horizontal seams then run at the target width
+    double v = static_cast<double>(verticalSeams);
+    double h = static_cast<double>(horizontalSeams);
+
+    double vertical_pixels = (target.height + h) * (v * target.width + v * (v + 1) / 2);
+    double horizontal_pixels = target.width * (h * target.height + h * (h + 1) / 2);
+
+    return costPerPixelMs * (vertical_pixels + horizontal_pixels);
+}
@@ -0,0 +1,50 @@
+#ifndef HYBRID_RETARGETER_HPP
+#define HYBRID_RETARGETER_HPP
+
+#include <opencv2/opencv.hpp>
+
+// Scale-then-carve retargeting. Part of the size reduction is done with a
+// plain resize and only the remaining seams are carved with the SeamCarver DP
+// path, so large reductions don't need thousands of full-resolution seams.
+class HybridRetargeter {
+public:
+    struct Options {
+        // Upper bound on the estimated carving time in milliseconds (<= 0: unlimited)
+        double timeBudgetMs = 0.0;
+
+        // Only carve as many seams as stay below this fraction of the mean
+        // image energy (e.g. 0.5); the rest is scaled (<= 0: unlimited)
+        double maxSeamEnergy = 0.0;
+    };
+
+    struct Report {
+        cv::Size sourceSize;
+        cv::Size scaledSize;        // size after the uniform resize step
+        cv::Size targetSize;
+        int verticalSeams = 0;      // seams carved after scaling
+        int horizontalSeams = 0;
+        double elapsedMs = 0.0;
+        double estimatedFullCarveMs = 0.0;  // cost model for carving everything
+        double timeSavedMs = 0.0;
+    };
+
+    explicit HybridRetargeter(const Options& options);
+
+    // Retarget image to target (which must not be larger in either dimension).
+    // At least one of the two limits in Options must be set.
+    cv::Mat retarget(const cv::Mat& image, const cv::Size& target, Report* report = nullptr) const;
+
+private:
+    Options options_;
+
+    // Measured DP + removal cost per pixel on a downscaled probe
+    static double measureCostPerPixelMs(const cv::Mat& image);
+
+    // Fraction of the probe's width that can be carved below the energy limit
+    double cheapSeamFraction(const cv::Mat& probe, bool vertical) const;
+
+    // Estimated time to carve from (target + seams) down to target
+    static double estimateCarveMs(double costPerPixelMs, const cv::Size& target, int verticalSeams, int horizontalSeams);
+};
+
+#endif
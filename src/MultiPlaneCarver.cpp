@@ -0,0 +1,258 @@
+#include "MultiPlaneCarver.hpp"
+#include "SeamCarver.hpp"
+#include <opencv2/opencv.hpp>
+#include <cstring>
+
+using namespace cv;
+using namespace std;
+
+MultiPlaneCarver::MultiPlaneCarver(vector<Mat> planes, vector<double> weights)
+    : planes_(std::move(planes)), weights_(std::move(weights)) {
+    if (planes_.empty()) {
+        cerr << "Error: Cannot create MultiPlaneCarver without planes!" << endl;
+        return;
+    }
+
+    for (int p = 0; p < planes_.size(); p++) {
+        if (planes_[p].empty() || planes_[p].size() != planes_[0].size()) {
+            cerr << "Error: Plane " << p << " is empty or doesn't match the size of plane 0!" << endl;
+            planes_.clear();
+            return;
+        }
+    }
+
+    if (weights_.empty()) {
+        weights_.assign(planes_.size(), 1.0);
+    }
+    else if (weights_.size() != planes_.size()) {
+        cerr << "Error: Got " << weights_.size() << " weights for "
+            << planes_.size() << " planes, using 1.0 for all!" << endl;
+        weights_.assign(planes_.size(), 1.0);
+    }
+}
+
+// ============================================================================
+// ENERGY
+// ============================================================================
+
+Mat MultiPlaneCarver::computeEnergyMap() const {
+    if (!energy_.empty()) {
+        return energy_;
+    }
+
+    if (planes_.empty()) {
+        cerr << "Error: No planes in computeEnergyMap!" << endl;
+        return Mat();
+    }
+
+    Mat combined = Mat::zeros(getHeight(), getWidth(), CV_32F);
+
+    for (int p = 0; p < planes_.size(); p++) {
+        if (weights_[p] == 0.0) {
+            continue;
+        }
+
+        // Reduce every plane to one channel so SeamCarver's gradient energy applies
+        const Mat& plane = planes_[p];
+        Mat gray;
+        Mat alpha;
+        if (plane.channels() == 4) {
+            cvtColor(plane, gray, COLOR_BGRA2GRAY);
+            vector<Mat> channels;
+            split(plane, channels);
+            alpha = channels[3];
+        }
+        else if (plane.channels() == 2) {
+            vector<Mat> channels;
+            split(plane, channels);
+            gray = channels[0];
+            alpha = channels[1];
+        }
+        else {
+            gray = plane;
+        }
+
+        Mat energy = SeamCarver::computeEnergyMap(gray);
+        if (energy.empty()) {
+            continue;
+        }
+
+        // Planes with alpha (gray + alpha or BGRA) also protect their alpha
+        // edges, so a mask doesn't have to be passed as a separate plane
+        if (!alpha.empty()) {
+            Mat alpha_energy = SeamCarver::computeEnergyMap(alpha);
+            if (!alpha_energy.empty()) {
+                add(energy, alpha_energy, energy);
+            }
+        }
+
+        // Planes have very different value ranges (8-bit colour, 16-bit depth,
+        // binary masks), so each one is scaled to [0, 1] before weighting
+        double max_energy = 0.0;
+        minMaxLoc(energy, nullptr, &max_energy);
+        if (max_energy > 0.0) {
+            scaleAdd(energy, weights_[p] / max_energy, combined, combined);
+        }
+    }
+
+    energy_ = combined;
+    return energy_;
+}
+
+Mat MultiPlaneCarver::getEnergyMap() const {
+    return computeEnergyMap().clone();
+}
+
+// ============================================================================
+// SEAM FINDING
+// ============================================================================
+
+vector<int> MultiPlaneCarver::findVerticalSeamDP() {
+    Mat energy = computeEnergyMap();
+
+    if (energy.empty()) {
+        cerr << "Error: Energy map is empty!" << endl;
+        return vector<int>();
+    }
+
+    return SeamCarver::findVerticalSeamInEnergy(energy, 0, energy.cols);
+}
+
+vector<int> MultiPlaneCarver::findHorizontalSeamDP() {
+    Mat energy = computeEnergyMap();
+
+    if (energy.empty()) {
+        cerr << "Error: Energy map is empty!" << endl;
+        return vector<int>();
+    }
+
+    return SeamCarver::findHorizontalSeamInEnergy(energy, 0, energy.rows);
+}
+
+// ============================================================================
+// FUSED SEAM REMOVAL
+// One walk over the rows compacts every plane, copying whole pixel runs with
+// memcpy so any plane type works.
+// ============================================================================
+
+void MultiPlaneCarver::removeVerticalSeam(const vector<int>& seam) {
+    int rows = getHeight();
+    int cols = getWidth();
+
+    if (seam.size() != rows) {
+        cerr << "Error: Seam size (" << seam.size()
+            << ") doesn't match image height (" << rows << ")!" << endl;
+        return;
+    }
+
+    if (cols <= 1) {
+        cerr << "Error: Image is too narrow to remove more seams!" << endl;
+        return;
+    }
+
+    for (int i = 0; i < rows; i++) {
+        if (seam[i] < 0 || seam[i] >= cols) {
+            cerr << "Error: Invalid seam position at row " << i
+                << ": " << seam[i] << " (cols: " << cols << ")" << endl;
+            return;
+        }
+    }
+
+    vector<Mat> new_planes(planes_.size());
+    for (int p = 0; p < planes_.size(); p++) {
+        new_planes[p].create(rows, cols - 1, planes_[p].type());
+    }
+
+    for (int i = 0; i < rows; i++) {
+        int seam_col = seam[i];
+
+        for (int p = 0; p < planes_.size(); p++) {
+            size_t pixel_size = planes_[p].elemSize();
+            const uchar* src = planes_[p].ptr(i);
+            uchar* dst = new_planes[p].ptr(i);
+
+            // Copy the pixels left of the seam, then the ones right of it
+            memcpy(dst, src, seam_col * pixel_size);
+            memcpy(dst + seam_col * pixel_size, src + (seam_col + 1) * pixel_size,
+                (cols - seam_col - 1) * pixel_size);
+        }
+    }
+
+    planes_ = std::move(new_planes);
+    energy_.release();
+}
+
+void MultiPlaneCarver::removeHorizontalSeam(const vector<int>& seam) {
+    int rows = getHeight();
+    int cols = getWidth();
+
+    if (seam.size() != cols) {
+        cerr << "Error: Seam size (" << seam.size()
+            << ") doesn't match image width (" << cols << ")!" << endl;
+        return;
+    }
+
+    if (rows <= 1) {
+        cerr << "Error: Image is too short to remove more seams!" << endl;
+        return;
+    }
+
+    for (int j = 0; j < cols; j++) {
+        if (seam[j] < 0 || seam[j] >= rows) {
+            cerr << "Error: Invalid seam position at col " << j
+                << ": " << seam[j] << " (rows: " << rows << ")" << endl;
+            return;
+        }
+    }
+
+    vector<Mat> new_planes(planes_.size());
+    for (int p = 0; p < planes_.size(); p++) {
+        new_planes[p].create(rows - 1, cols, planes_[p].type());
+    }
+
+    // Output row i takes source row i in the columns where the seam lies below
+    // it and row i + 1 elsewhere. Those columns form runs that are found once
+    // per row and then copied with one memcpy per run in every plane.
+    vector<int> run_start;
+    vector<int> run_end;
+    vector<bool> run_below;
+
+    for (int i = 0; i < rows - 1; i++) {
+        run_start.clear();
+        run_end.clear();
+        run_below.clear();
+
+        int start = 0;
+        for (int j = 1; j <= cols; j++) {
+            if (j == cols || (i < seam[j]) != (i < seam[start])) {
+                run_start.push_back(start);
+                run_end.push_back(j);
+                run_below.push_back(i >= seam[start]);
+                start = j;
+            }
+        }
+
+        for (int p = 0; p < planes_.size(); p++) {
+            size_t pixel_size = planes_[p].elemSize();
+            const uchar* src = planes_[p].ptr(i);
+            const uchar* src_below = planes_[p].ptr(i + 1);
+            uchar* dst = new_planes[p].ptr(i);
+
+            for (int r = 0; r < run_start.size(); r++) {
+                const uchar* from = run_below[r] ? src_below : src;
+                size_t offset = run_start[r] * pixel_size;
+                memcpy(dst + offset, from + offset, (run_end[r] - run_start[r]) * pixel_size);
+            }
+        }
+    }
+
+    planes_ = std::move(new_planes);
+    energy_.release();
+}
+
+vector<Mat> MultiPlaneCarver::release() {
+    energy_.release();
+    vector<Mat> planes = std::move(planes_);
+    planes_.clear();
+    return planes;
+}
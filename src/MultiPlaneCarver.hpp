@@ -0,0 +1,48 @@
+#ifndef MULTI_PLANE_CARVER_HPP
+#define MULTI_PLANE_CARVER_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Carves a set of aligned planes (e.g. an RGB image with its alpha mask,
+// depth map or stereo partner) together. Each seam is found once on a
+// combined energy map and removed from every plane in the same pass, so the
+// planes stay registered pixel for pixel.
+class MultiPlaneCarver {
+public:
+    // All planes must have the same size; type and channel count may differ.
+    // Weights scale each plane's contribution to the combined energy (default 1).
+    // Planes are adopted without copying and their pixels are never written.
+    MultiPlaneCarver(std::vector<cv::Mat> planes, std::vector<double> weights = std::vector<double>());
+
+    // Dynamic Programming seam finding on the combined energy
+    std::vector<int> findVerticalSeamDP();
+    std::vector<int> findHorizontalSeamDP();
+
+    // Remove a seam from every plane in one fused pass
+    void removeVerticalSeam(const std::vector<int>& seam);
+    void removeHorizontalSeam(const std::vector<int>& seam);
+
+    // Getters
+    const std::vector<cv::Mat>& getPlanes() const { return planes_; }
+    cv::Mat getEnergyMap() const;
+    int getWidth() const { return planes_.empty() ? 0 : planes_[0].cols; }
+    int getHeight() const { return planes_.empty() ? 0 : planes_[0].rows; }
+
+    // Move the carved planes out; the carver is left empty
+    std::vector<cv::Mat> release();
+
+private:
+    std::vector<cv::Mat> planes_;
+    std::vector<double> weights_;
+
+    // Combined energy, computed on demand and dropped after every removal
+    mutable cv::Mat energy_;
+
+    // Weighted sum of the per-plane energies, each scaled to [0, 1]. A plane
+    // with alpha (gray + alpha or BGRA) contributes both its colour and its
+    // alpha gradients.
+    cv::Mat computeEnergyMap() const;
+};
+
+#endif
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <limits>
 #include <cmath>
+#include <cstring>
 
 using namespace cv;
 using namespace std;
@@ -11,27 +12,65 @@ SeamCarver::SeamCarver(const Mat& image) : image_(image.clone()) {
     if (image_.empty()) {
         cerr << "Error: Cannot create SeamCarver with empty image!" << endl;
     }
+    stats_.frameCopies++;
 }
 
-Mat SeamCarver::computeEnergyMap() const {
+SeamCarver::SeamCarver(Mat&& image) : image_(std::move(image)) {
     if (image_.empty()) {
+        cerr << "Error: Cannot create SeamCarver with empty image!" << endl;
+    }
+}
+
+// ============================================================================
+// ACCESSORS
+// ============================================================================
+
+Mat SeamCarver::getImage() const {
+    stats_.frameCopies++;
+    return image_.clone();
+}
+
+Mat SeamCarver::imageView() const {
+    // Plain header copy: shares the buffer (and its reference count) without
+    // copying pixels, so it stays valid after image_ is replaced
+    return image_;
+}
+
+Mat SeamCarver::energyView() const {
+    return computeEnergyMap();
+}
+
+Mat SeamCarver::release() {
+    energy_.release();
+    return std::move(image_);
+}
+
+Mat SeamCarver::computeEnergyMap() const {
+    if (energy_.empty()) {
+        energy_ = computeEnergyMap(image_);
+    }
+    return energy_;
+}
+
+Mat SeamCarver::computeEnergyMap(const Mat& image) {
+    if (image.empty()) {
         cerr << "Error: Image is empty in computeEnergyMap!" << endl;
         return Mat();
     }
 
     Mat gray;
 
-    // Convert to grayscale if needed
-    if (image_.channels() == 3) {
-        cvtColor(image_, gray, COLOR_BGR2GRAY);
+    // Convert to grayscale if needed, then to float for better precision.
+    // Single-channel input is converted straight into a new buffer, so it
+    // isn't cloned first.
+    if (image.channels() == 3) {
+        cvtColor(image, gray, COLOR_BGR2GRAY);
+        gray.convertTo(gray, CV_32F);
     }
     else {
-        gray = image_.clone();
+        image.convertTo(gray, CV_32F);
     }
 
-    // Convert to float for better precision
-    gray.convertTo(gray, CV_32F);
-
     // Compute gradients using Sobel operator
     Mat grad_x, grad_y;
     Sobel(gray, grad_x, CV_32F, 1, 0, 3);  // Horizontal gradient
@@ -45,7 +84,8 @@ Mat SeamCarver::computeEnergyMap() const {
 }
 
 Mat SeamCarver::getEnergyMap() const {
-    return computeEnergyMap();
+    stats_.frameCopies++;
+    return computeEnergyMap().clone();
 }
 
 // ============================================================================
@@ -60,6 +100,10 @@ vector<int> SeamCarver::findVerticalSeamDP() {
         return vector<int>();
     }
 
+    return findVerticalSeamInEnergy(energy, 0, energy.cols);
+}
+
+vector<int> SeamCarver::findVerticalSeamInEnergy(const Mat& energy, int colStart, int colEnd) {
     int rows = energy.rows;
     int cols = energy.cols;
 
@@ -68,20 +112,30 @@ vector<int> SeamCarver::findVerticalSeamDP() {
         return vector<int>();
     }
 
+    if (colStart < 0 || colEnd > cols || colStart >= colEnd) {
+        cerr << "Error: Invalid column range [" << colStart << ", " << colEnd
+            << ") for energy map width " << cols << "!" << endl;
+        return vector<int>();
+    }
+
+    // Only the window [colStart, colEnd) takes part in the search, so the
+    // DP tables are sized to the window rather than the full energy map
+    int width = colEnd - colStart;
+
     // DP table: stores minimum cumulative energy to reach each pixel
-    Mat dp(rows, cols, CV_64F);
+    Mat dp(rows, width, CV_64F);
 
     // Backtrack table: stores which column in previous row led to minimum
-    Mat backtrack(rows, cols, CV_32S);
+    Mat backtrack(rows, width, CV_32S);
 
     // Initialize first row with energy values
-    for (int j = 0; j < cols; j++) {
-        dp.at<double>(0, j) = energy.at<float>(0, j);
+    for (int j = 0; j < width; j++) {
+        dp.at<double>(0, j) = energy.at<float>(0, colStart + j);
     }
 
     // Fill DP table row by row (top to bottom)
     for (int i = 1; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
+        for (int j = 0; j < width; j++) {
             // Start with pixel directly above
             double min_energy = dp.at<double>(i - 1, j);
             int min_col = j;
@@ -96,7 +150,7 @@ vector<int> SeamCarver::findVerticalSeamDP() {
             }
 
             // Check upper-right diagonal (if exists)
-            if (j < cols - 1) {
+            if (j < width - 1) {
                 double upper_right = dp.at<double>(i - 1, j + 1);
                 if (upper_right < min_energy) {
                     min_energy = upper_right;
@@ -105,7 +159,7 @@ vector<int> SeamCarver::findVerticalSeamDP() {
             }
 
             // Store cumulative energy and backtrack info
-            dp.at<double>(i, j) = energy.at<float>(i, j) + min_energy;
+            dp.at<double>(i, j) = energy.at<float>(i, colStart + j) + min_energy;
             backtrack.at<int>(i, j) = min_col;
         }
     }
@@ -114,7 +168,7 @@ vector<int> SeamCarver::findVerticalSeamDP() {
     int min_col = 0;
     double min_energy = dp.at<double>(rows - 1, 0);
 
-    for (int j = 1; j < cols; j++) {
+    for (int j = 1; j < width; j++) {
         if (dp.at<double>(rows - 1, j) < min_energy) {
             min_energy = dp.at<double>(rows - 1, j);
             min_col = j;
@@ -129,6 +183,11 @@ vector<int> SeamCarver::findVerticalSeamDP() {
         seam[i] = backtrack.at<int>(i + 1, seam[i + 1]);
     }
 
+    // Convert window-relative columns back to energy map columns
+    for (int i = 0; i < rows; i++) {
+        seam[i] += colStart;
+    }
+
     return seam;
 }
 
@@ -140,6 +199,10 @@ vector<int> SeamCarver::findHorizontalSeamDP() {
         return vector<int>();
     }
 
+    return findHorizontalSeamInEnergy(energy, 0, energy.rows);
+}
+
+vector<int> SeamCarver::findHorizontalSeamInEnergy(const Mat& energy, int rowStart, int rowEnd) {
     int rows = energy.rows;
     int cols = energy.cols;
 
@@ -148,20 +211,28 @@ vector<int> SeamCarver::findHorizontalSeamDP() {
         return vector<int>();
     }
 
+    if (rowStart < 0 || rowEnd > rows || rowStart >= rowEnd) {
+        cerr << "Error: Invalid row range [" << rowStart << ", " << rowEnd
+            << ") for energy map height " << rows << "!" << endl;
+        return vector<int>();
+    }
+
+    int height = rowEnd - rowStart;
+
     // DP table: stores minimum cumulative energy to reach each pixel
-    Mat dp(rows, cols, CV_64F);
+    Mat dp(height, cols, CV_64F);
 
     // Backtrack table: stores which row in previous column led to minimum
-    Mat backtrack(rows, cols, CV_32S);
+    Mat backtrack(height, cols, CV_32S);
 
     // Initialize first column with energy values
-    for (int i = 0; i < rows; i++) {
-        dp.at<double>(i, 0) = energy.at<float>(i, 0);
+    for (int i = 0; i < height; i++) {
+        dp.at<double>(i, 0) = energy.at<float>(rowStart + i, 0);
     }
 
     // Fill DP table column by column (left to right)
     for (int j = 1; j < cols; j++) {
-        for (int i = 0; i < rows; i++) {
+        for (int i = 0; i < height; i++) {
             // Start with pixel directly to the left
             double min_energy = dp.at<double>(i, j - 1);
             int min_row = i;
@@ -176,7 +247,7 @@ vector<int> SeamCarver::findHorizontalSeamDP() {
             }
 
             // Check lower-left diagonal (if exists)
-            if (i < rows - 1) {
+            if (i < height - 1) {
                 double lower_left = dp.at<double>(i + 1, j - 1);
                 if (lower_left < min_energy) {
                     min_energy = lower_left;
@@ -185,7 +256,7 @@ vector<int> SeamCarver::findHorizontalSeamDP() {
             }
 
             // Store cumulative energy and backtrack info
-            dp.at<double>(i, j) = energy.at<float>(i, j) + min_energy;
+            dp.at<double>(i, j) = energy.at<float>(rowStart + i, j) + min_energy;
             backtrack.at<int>(i, j) = min_row;
         }
     }
@@ -194,7 +265,7 @@ vector<int> SeamCarver::findHorizontalSeamDP() {
     int min_row = 0;
     double min_energy = dp.at<double>(0, cols - 1);
 
-    for (int i = 1; i < rows; i++) {
+    for (int i = 1; i < height; i++) {
         if (dp.at<double>(i, cols - 1) < min_energy) {
             min_energy = dp.at<double>(i, cols - 1);
             min_row = i;
@@ -209,9 +280,230 @@ vector<int> SeamCarver::findHorizontalSeamDP() {
         seam[j] = backtrack.at<int>(seam[j + 1], j + 1);
     }
 
+    // Convert window-relative rows back to energy map rows
+    for (int j = 0; j < cols; j++) {
+        seam[j] += rowStart;
+    }
+
     return seam;
 }
 
+// ============================================================================
+// REGION-LIMITED CARVING
+// Energy, DP and compaction only touch the selected band plus a one-pixel
+// halo on each side, so the Sobel gradients at the band edges still see
+// their real neighbours while the cost scales with the band size.
+// ============================================================================
+
+vector<int> SeamCarver::findVerticalSeamDP(int colStart, int colEnd) {
+    if (image_.empty()) {
+        cerr << "Error: Image is empty in findVerticalSeamDP!" << endl;
+        return vector<int>();
+    }
+
+    if (colStart < 0 || colEnd > image_.cols || colStart >= colEnd) {
+        cerr << "Error: Invalid column range [" << colStart << ", " << colEnd
+            << ") for image width " << image_.cols << "!" << endl;
+        return vector<int>();
+    }
+
+    int halo_start = max(colStart - 1, 0);
+    int halo_end = min(colEnd + 1, image_.cols);
+
+    // colRange only creates a header, no pixels are copied here
+    Mat energy = computeEnergyMap(image_.colRange(halo_start, halo_end));
+    vector<int> seam = findVerticalSeamInEnergy(energy, colStart - halo_start, colEnd - halo_start);
+
+    for (int i = 0; i < seam.size(); i++) {
+        seam[i] += halo_start;
+    }
+
+    return seam;
+}
+
+int SeamCarver::carveVerticalSeamsInRange(int colStart, int colEnd, int count) {
+    if (image_.empty()) {
+        cerr << "Error: Image is empty in carveVerticalSeamsInRange!" << endl;
+        return 0;
+    }
+
+    if (colStart < 0 || colEnd > image_.cols || colStart >= colEnd) {
+        cerr << "Error: Invalid column range [" << colStart << ", " << colEnd
+            << ") for image width " << image_.cols << "!" << endl;
+        return 0;
+    }
+
+    // Keep at least one column of the band
+    count = min(count, colEnd - colStart - 1);
+    if (count <= 0) {
+        return 0;
+    }
+
+    int halo_start = max(colStart - 1, 0);
+    int halo_end = min(colEnd + 1, image_.cols);
+
+    // Work on a private copy of the band; the halo columns are never carved
+    Mat band = image_.colRange(halo_start, halo_end).clone();
+    int inner_start = colStart - halo_start;
+    int inner_end = colEnd - halo_start;
+
+    int removed = 0;
+    for (; removed < count; removed++) {
+        Mat energy = computeEnergyMap(band);
+        vector<int> seam = findVerticalSeamInEnergy(energy, inner_start, inner_end);
+
+        if (seam.empty() || !removeVerticalSeamFrom(band, seam)) {
+            break;
+        }
+
+        inner_end--;
+    }
+
+    // Splice the carved band back between the untouched left and right parts
+    vector<Mat> parts;
+    if (halo_start > 0) {
+        parts.push_back(image_.colRange(0, halo_start));
+    }
+    parts.push_back(band);
+    if (halo_end < image_.cols) {
+        parts.push_back(image_.colRange(halo_end, image_.cols));
+    }
+
+    Mat result;
+    hconcat(parts, result);
+    image_ = result;
+    energy_.release();
+    stats_.frameCopies++;
+    stats_.seamsRemoved += removed;
+
+    return removed;
+}
+
+// ============================================================================
+// SEAM INDEX MAP
+// Records the removal order of every pixel so that repeated requests for
+// different widths of the same image only need a compaction pass.
+// ============================================================================
+
+Mat SeamCarver::computeVerticalSeamOrder(int seams, const Mat& previous, int previousDepth, const Mat& startEnergy) const {
+    if (image_.empty()) {
+        cerr << "Error: Image is empty in computeVerticalSeamOrder!" << endl;
+        return Mat();
+    }
+
+    seams = max(0, min(seams, image_.cols - 1));
+
+    int rows = image_.rows;
+    int depth = 0;
+    Mat order;
+
+    if (previousDepth > 0 && previous.rows == rows && previous.cols == image_.cols) {
+        // Resume: the steps already recorded stay valid, only the rest are run
+        order = previous.clone();
+        depth = min(previousDepth, seams);
+    }
+    else {
+        order = Mat(rows, image_.cols, CV_32S, Scalar(numeric_limits<int>::max()));
+    }
+
+    // Image after the recorded steps. Removal never writes into its input, so
+    // when starting fresh the working image can share image_.
+    Mat working = image_;
+    if (depth > 0) {
+        working = applyVerticalSeamOrder(image_, order, image_.cols - depth);
+        if (working.empty()) {
+            return Mat();
+        }
+    }
+
+    // Original column of every pixel in the shrinking working image
+    Mat columns(rows, working.cols, CV_32S);
+    for (int i = 0; i < rows; i++) {
+        int out = 0;
+        for (int j = 0; j < image_.cols; j++) {
+            if (order.at<int>(i, j) >= depth) {
+                columns.at<int>(i, out++) = j;
+            }
+        }
+    }
+
+    for (int step = depth; step < seams; step++) {
+        // A precomputed energy map of image_ can stand in for the first step
+        bool use_start = step == 0 && startEnergy.rows == rows && startEnergy.cols == working.cols;
+        Mat energy = use_start ? startEnergy : computeEnergyMap(working);
+        vector<int> seam = findVerticalSeamInEnergy(energy, 0, energy.cols);
+
+        if (seam.empty()) {
+            break;
+        }
+
+        // Mark the seam pixels and drop them from the column lookup
+        Mat new_columns(rows, columns.cols - 1, CV_32S);
+        for (int i = 0; i < rows; i++) {
+            int seam_col = seam[i];
+            order.at<int>(i, columns.at<int>(i, seam_col)) = step;
+
+            for (int j = 0; j < seam_col; j++) {
+                new_columns.at<int>(i, j) = columns.at<int>(i, j);
+            }
+            for (int j = seam_col + 1; j < columns.cols; j++) {
+                new_columns.at<int>(i, j - 1) = columns.at<int>(i, j);
+            }
+        }
+        columns = new_columns;
+
+        if (!removeVerticalSeamFrom(working, seam)) {
+            break;
+        }
+    }
+
+    return order;
+}
+
+Mat SeamCarver::applyVerticalSeamOrder(const Mat& image, const Mat& order, int targetWidth) {
+    if (image.empty() || order.rows != image.rows || order.cols != image.cols) {
+        cerr << "Error: Seam order map doesn't match image in applyVerticalSeamOrder!" << endl;
+        return Mat();
+    }
+
+    if (targetWidth <= 0 || targetWidth > image.cols) {
+        cerr << "Error: Invalid target width " << targetWidth
+            << " for image width " << image.cols << "!" << endl;
+        return Mat();
+    }
+
+    // Pixels removed in the first `removed` steps are dropped, the rest kept
+    int removed = image.cols - targetWidth;
+    size_t pixel_size = image.elemSize();
+    Mat result(image.rows, targetWidth, image.type());
+
+    for (int i = 0; i < image.rows; i++) {
+        const uchar* src = image.ptr(i);
+        const int* steps = order.ptr<int>(i);
+        uchar* dst = result.ptr(i);
+        int out = 0;
+
+        for (int j = 0; j < image.cols; j++) {
+            if (steps[j] >= removed) {
+                if (out == targetWidth) {
+                    cerr << "Error: Seam order map is not deep enough for width "
+                        << targetWidth << "!" << endl;
+                    return Mat();
+                }
+                memcpy(dst + out * pixel_size, src + j * pixel_size, pixel_size);
+                out++;
+            }
+        }
+
+        if (out != targetWidth) {
+            cerr << "Error: Seam order map is inconsistent at row " << i << "!" << endl;
+            return Mat();
+        }
+    }
+
+    return result;
+}
+
 // ============================================================================
 // GREEDY ALGORITHM IMPLEMENTATION
 // TODO: Update dis shizz
@@ -321,79 +613,97 @@ vector<int> SeamCarver::findHorizontalSeamGreedy() {
 // ============================================================================
 
 void SeamCarver::removeVerticalSeam(const vector<int>& seam) {
-    if (seam.size() != image_.rows) {
+    if (removeVerticalSeamFrom(image_, seam)) {
+        energy_.release();
+        stats_.frameCopies++;
+        stats_.seamsRemoved++;
+    }
+}
+
+bool SeamCarver::removeVerticalSeamFrom(Mat& image, const vector<int>& seam) {
+    if (seam.size() != image.rows) {
         cerr << "Error: Seam size (" << seam.size()
-            << ") doesn't match image height (" << image_.rows << ")!" << endl;
-        return;
+            << ") doesn't match image height (" << image.rows << ")!" << endl;
+        return false;
     }
 
-    if (image_.cols <= 1) {
+    if (image.cols <= 1) {
         cerr << "Error: Image is too narrow to remove more seams!" << endl;
-        return;
+        return false;
     }
 
     // Create new image with one less column
-    Mat new_image(image_.rows, image_.cols - 1, image_.type());
+    Mat new_image(image.rows, image.cols - 1, image.type());
 
-    for (int i = 0; i < image_.rows; i++) {
+    for (int i = 0; i < image.rows; i++) {
         int seam_col = seam[i];
 
         // Validate seam position
-        if (seam_col < 0 || seam_col >= image_.cols) {
+        if (seam_col < 0 || seam_col >= image.cols) {
             cerr << "Error: Invalid seam position at row " << i
-                << ": " << seam_col << " (cols: " << image_.cols << ")" << endl;
-            return;
+                << ": " << seam_col << " (cols: " << image.cols << ")" << endl;
+            return false;
         }
 
         // Copy all pixels except the seam pixel
         for (int j = 0; j < seam_col; j++) {
-            new_image.at<Vec3b>(i, j) = image_.at<Vec3b>(i, j);
+            new_image.at<Vec3b>(i, j) = image.at<Vec3b>(i, j);
         }
 
-        for (int j = seam_col + 1; j < image_.cols; j++) {
-            new_image.at<Vec3b>(i, j - 1) = image_.at<Vec3b>(i, j);
+        for (int j = seam_col + 1; j < image.cols; j++) {
+            new_image.at<Vec3b>(i, j - 1) = image.at<Vec3b>(i, j);
         }
     }
 
-    image_ = new_image;
+    image = new_image;
+    return true;
 }
 
 void SeamCarver::removeHorizontalSeam(const vector<int>& seam) {
-    if (seam.size() != image_.cols) {
+    if (removeHorizontalSeamFrom(image_, seam)) {
+        energy_.release();
+        stats_.frameCopies++;
+        stats_.seamsRemoved++;
+    }
+}
+
+bool SeamCarver::removeHorizontalSeamFrom(Mat& image, const vector<int>& seam) {
+    if (seam.size() != image.cols) {
         cerr << "Error: Seam size (" << seam.size()
-            << ") doesn't match image width (" << image_.cols << ")!" << endl;
-        return;
+            << ") doesn't match image width (" << image.cols << ")!" << endl;
+        return false;
     }
 
-    if (image_.rows <= 1) {
+    if (image.rows <= 1) {
         cerr << "Error: Image is too short to remove more seams!" << endl;
-        return;
+        return false;
     }
 
     // Create new image with one less row
-    Mat new_image(image_.rows - 1, image_.cols, image_.type());
+    Mat new_image(image.rows - 1, image.cols, image.type());
 
-    for (int j = 0; j < image_.cols; j++) {
+    for (int j = 0; j < image.cols; j++) {
         int seam_row = seam[j];
 
         // Validate seam position
-        if (seam_row < 0 || seam_row >= image_.rows) {
+        if (seam_row < 0 || seam_row >= image.rows) {
             cerr << "Error: Invalid seam position at col " << j
-                << ": " << seam_row << " (rows: " << image_.rows << ")" << endl;
-            return;
+                << ": " << seam_row << " (rows: " << image.rows << ")" << endl;
+            return false;
         }
 
         // Copy all pixels except the seam pixel
         for (int i = 0; i < seam_row; i++) {
-            new_image.at<Vec3b>(i, j) = image_.at<Vec3b>(i, j);
+            new_image.at<Vec3b>(i, j) = image.at<Vec3b>(i, j);
         }
 
-        for (int i = seam_row + 1; i < image_.rows; i++) {
-            new_image.at<Vec3b>(i - 1, j) = image_.at<Vec3b>(i, j);
+        for (int i = seam_row + 1; i < image.rows; i++) {
+            new_image.at<Vec3b>(i - 1, j) = image.at<Vec3b>(i, j);
         }
     }
 
-    image_ = new_image;
+    image = new_image;
+    return true;
 }
 
 // ============================================================================
@@ -403,10 +713,12 @@ void SeamCarver::removeHorizontalSeam(const vector<int>& seam) {
 Mat SeamCarver::visualizeVerticalSeam(const vector<int>& seam, const Scalar& color) {
     if (seam.size() != image_.rows) {
         cerr << "Error: Seam size doesn't match image height in visualization!" << endl;
+        stats_.frameCopies++;
         return image_.clone();
     }
 
     Mat result = image_.clone();
+    stats_.frameCopies++;
 
     // Draw the seam with specified color
     for (int i = 0; i < seam.size(); i++) {
@@ -437,10 +749,12 @@ Mat SeamCarver::visualizeVerticalSeam(const vector<int>& seam, const Scalar& col
 Mat SeamCarver::visualizeHorizontalSeam(const vector<int>& seam, const Scalar& color) {
     if (seam.size() != image_.cols) {
         cerr << "Error: Seam size doesn't match image width in visualization!" << endl;
+        stats_.frameCopies++;
         return image_.clone();
     }
 
     Mat result = image_.clone();
+    stats_.frameCopies++;
 
     // Draw the seam with specified color
     for (int j = 0; j < seam.size(); j++) {
@@ -6,12 +6,45 @@
 
 class SeamCarver {
 public:
+    // Full-frame buffer copies made by a carver, for checking per-seam copy
+    // counts: the copying constructor, getImage(), getEnergyMap(), visualize*,
+    // every seam removal and every band splice
+    struct CopyStats {
+        size_t frameCopies = 0;
+        size_t seamsRemoved = 0;
+    };
+
+    // Copies the image
     SeamCarver(const cv::Mat& image);
 
+    // Adopts the image buffer without copying. The carver never writes into
+    // the adopted pixels (removal builds a new buffer), so a header shared
+    // with the caller stays unchanged.
+    explicit SeamCarver(cv::Mat&& image);
+
     // Dynamic Programming seam finding
     std::vector<int> findVerticalSeamDP();
     std::vector<int> findHorizontalSeamDP();
 
+    // Region-limited seam finding (used for the region preview): the seam stays
+    // inside [colStart, colEnd) and only that band (plus a one-pixel halo) is
+    // processed. Returned positions are in full-image coordinates.
+    std::vector<int> findVerticalSeamDP(int colStart, int colEnd);
+
+    // Remove up to count seams confined to [colStart, colEnd); returns how many were removed
+    int carveVerticalSeamsInRange(int colStart, int colEnd, int count);
+
+    // Seam index map: for every pixel of the current image, the step at which
+    // it is removed when carving `seams` vertical seams with DP (INT_MAX if it
+    // survives). Any width >= getWidth() - seams can then be produced by
+    // compaction alone with applyVerticalSeamOrder. Passing a map that already
+    // holds previousDepth steps resumes from there instead of starting over.
+    // startEnergy, if given, is the energy map of the current image and saves
+    // recomputing it for the first step.
+    cv::Mat computeVerticalSeamOrder(int seams, const cv::Mat& previous = cv::Mat(), int previousDepth = 0,
+        const cv::Mat& startEnergy = cv::Mat()) const;
+    static cv::Mat applyVerticalSeamOrder(const cv::Mat& image, const cv::Mat& order, int targetWidth);
+
     // Greedy Algorithm seam finding (TODO)
     std::vector<int> findVerticalSeamGreedy();
     std::vector<int> findHorizontalSeamGreedy();
@@ -24,17 +57,44 @@ public:
     cv::Mat visualizeVerticalSeam(const std::vector<int>& seam, const cv::Scalar& color = cv::Scalar(0, 0, 255));
     cv::Mat visualizeHorizontalSeam(const std::vector<int>& seam, const cv::Scalar& color = cv::Scalar(0, 255, 0));
 
-    // Getters
-    cv::Mat getImage() const { return image_.clone(); }
+    // Getters (return owning copies)
+    cv::Mat getImage() const;
     cv::Mat getEnergyMap() const;
     int getWidth() const { return image_.cols; }
     int getHeight() const { return image_.rows; }
 
+    // Headers sharing the working buffers; no pixels are copied. A view keeps
+    // its buffer alive, so it stays valid (but shows the old state) after a
+    // removal, carve or release(). Never write through a view: the buffer may
+    // be an image the caller handed over or a cache entry.
+    cv::Mat imageView() const;
+    cv::Mat energyView() const;
+
+    // Move the working image out; the carver is left empty
+    cv::Mat release();
+
+    const CopyStats& copyStats() const { return stats_; }
+
+    // Building blocks shared with the other carving front-ends
+    static cv::Mat computeEnergyMap(const cv::Mat& image);
+
+    // DP seam search restricted to a window of an energy map
+    static std::vector<int> findVerticalSeamInEnergy(const cv::Mat& energy, int colStart, int colEnd);
+    static std::vector<int> findHorizontalSeamInEnergy(const cv::Mat& energy, int rowStart, int rowEnd);
+
 private:
     cv::Mat image_;
 
-    // Compute energy map using gradient magnitude
+    // Energy of image_, computed on demand and dropped whenever image_ changes
+    mutable cv::Mat energy_;
+    mutable CopyStats stats_;
+
+    // Compute energy map using gradient magnitude (cached in energy_)
     cv::Mat computeEnergyMap() const;
+
+    // Remove a seam from an arbitrary image (used on the full image and on bands)
+    static bool removeVerticalSeamFrom(cv::Mat& image, const std::vector<int>& seam);
+    static bool removeHorizontalSeamFrom(cv::Mat& image, const std::vector<int>& seam);
 };
 
 #endif
\ No newline at end of file
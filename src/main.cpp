@@ -1,11 +1,227 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
 #include "SeamCarver.hpp"
+#include "CarveServer.hpp"
+#include "HybridRetargeter.hpp"
+#include "AsyncImageWriter.hpp"
+#include "MultiPlaneCarver.hpp"
+#include <sstream>
 
 using namespace cv;
 using namespace std;
 
 int main(int argc, char** argv) {
+    // Server mode: SeamCarving --serve [cache_mb]
+    // Reads carve requests from stdin and answers on stdout (see CarveServer.hpp)
+    if (argc > 1 && string(argv[1]) == "--serve") {
+        size_t cache_mb = argc > 2 ? strtoul(argv[2], nullptr, 10) : 512;
+        CarveServer server(cache_mb * 1024 * 1024);
+        return server.run(cin, cout);
+    }
+
+    // Hybrid mode: SeamCarving --hybrid <input> <output> <width> <height> [--budget-ms N] [--max-energy T]
+    if (argc > 1 && string(argv[1]) == "--hybrid") {
+        // Options come in flag/value pairs after the four positional arguments
+        if (argc < 6 || (argc - 6) % 2 != 0) {
+            cout << "Usage: " << argv[0] << " --hybrid <input> <output> <width> <height>"
+                << " [--budget-ms N] [--max-energy T]" << endl;
+            return -1;
+        }
+
+        HybridRetargeter::Options options;
+        for (int i = 6; i + 1 < argc; i += 2) {
+            string flag = argv[i];
+            double* value = nullptr;
+            if (flag == "--budget-ms") {
+                value = &options.timeBudgetMs;
+            }
+            else if (flag == "--max-energy") {
+                value = &options.maxSeamEnergy;
+            }
+            else {
+                cout << "Unknown option: " << flag << endl;
+                return -1;
+            }
+
+            // Whole value must be a non-negative number: reject things like "5ms"
+            char* end = nullptr;
+            *value = strtod(argv[i + 1], &end);
+            if (end == argv[i + 1] || *end != '\0' || !(*value >= 0.0)) {
+                cout << "Invalid value for " << flag << ": '" << argv[i + 1] << "'" << endl;
+                return -1;
+            }
+        }
+
+        if (options.timeBudgetMs <= 0.0 && options.maxSeamEnergy <= 0.0) {
+            cout << "Error: --hybrid needs --budget-ms and/or --max-energy" << endl;
+            return -1;
+        }
+
+        Mat input = imread(argv[2]);
+        if (input.empty()) {
+            cout << "Error: Could not load image from: " << argv[2] << endl;
+            return -1;
+        }
+
+        HybridRetargeter retargeter(options);
+        HybridRetargeter::Report report;
+        Mat result = retargeter.retarget(input, Size(atoi(argv[4]), atoi(argv[5])), &report);
+        if (result.empty()) {
+            return -1;
+        }
+
+        imwrite(argv[3], result);
+
+        cout << "Source size:  " << report.sourceSize.width << "x" << report.sourceSize.height << endl;
+        cout << "Scaled to:    " << report.scaledSize.width << "x" << report.scaledSize.height << endl;
+        cout << "Seams carved: " << report.verticalSeams << " vertical, "
+            << report.horizontalSeams << " horizontal" << endl;
+        cout << "Result size:  " << result.cols << "x" << result.rows << endl;
+        cout << format("Time: %.1f ms (full carve estimate %.1f ms, saved %.1f ms)",
+            report.elapsedMs, report.estimatedFullCarveMs, report.timeSavedMs) << endl;
+        cout << "Saved result to: " << argv[3] << endl;
+        return 0;
+    }
+
+    // Joint mode: SeamCarving --joint <width> <height> <input> <output> [<input> <output> ...]
+    // Carves aligned planes (image, mask, depth, stereo partner) with shared seams.
+    if (argc > 1 && string(argv[1]) == "--joint") {
+        if (argc < 6 || (argc - 4) % 2 != 0) {
+            cout << "Usage: " << argv[0] << " --joint <width> <height> <input> <output>"
+                << " [<input> <output> ...]" << endl;
+            return -1;
+        }
+
+        int target_width = atoi(argv[2]);
+        int target_height = atoi(argv[3]);
+
+        // Load unchanged so masks and 16-bit depth maps keep their format
+        vector<Mat> planes;
+        vector<string> outputs;
+        for (int i = 4; i + 1 < argc; i += 2) {
+            Mat plane = imread(argv[i], IMREAD_UNCHANGED);
+            if (plane.empty()) {
+                cout << "Error: Could not load image from: " << argv[i] << endl;
+                return -1;
+            }
+            planes.push_back(plane);
+            outputs.push_back(argv[i + 1]);
+        }
+
+        MultiPlaneCarver carver(std::move(planes));
+        if (carver.getPlanes().empty()) {
+            return -1;
+        }
+
+        if (target_width <= 0 || target_height <= 0
+            || target_width > carver.getWidth() || target_height > carver.getHeight()) {
+            cout << "Error: Target size must be within " << carver.getWidth()
+                << "x" << carver.getHeight() << endl;
+            return -1;
+        }
+
+        while (carver.getWidth() > target_width) {
+            vector<int> seam = carver.findVerticalSeamDP();
+            if (seam.empty()) {
+                break;
+            }
+            carver.removeVerticalSeam(seam);
+        }
+
+        while (carver.getHeight() > target_height) {
+            vector<int> seam = carver.findHorizontalSeamDP();
+            if (seam.empty()) {
+                break;
+            }
+            carver.removeHorizontalSeam(seam);
+        }
+
+        vector<Mat> carved_planes = carver.release();
+        int failures = 0;
+        for (int i = 0; i < carved_planes.size(); i++) {
+            if (!imwrite(outputs[i], carved_planes[i])) {
+                cout << "Error: Could not write " << outputs[i] << endl;
+                failures++;
+                continue;
+            }
+            cout << "Saved " << carved_planes[i].cols << "x" << carved_planes[i].rows
+                << " plane to: " << outputs[i] << endl;
+        }
+        return failures == 0 ? 0 : -1;
+    }
+
+    // Progressive mode: SeamCarving --progressive <input> <output_prefix> <percent,percent,...>
+    // One carving pass down to the smallest width; every requested width is
+    // written as the pass goes through it.
+    if (argc > 1 && string(argv[1]) == "--progressive") {
+        if (argc < 5) {
+            cout << "Usage: " << argv[0] << " --progressive <input> <output_prefix> <percent,percent,...>" << endl;
+            return -1;
+        }
+
+        Mat input = imread(argv[2]);
+        if (input.empty()) {
+            cout << "Error: Could not load image from: " << argv[2] << endl;
+            return -1;
+        }
+
+        // Parse the percentages and carve from the widest to the narrowest target
+        vector<int> percents;
+        stringstream list(argv[4]);
+        string item;
+        while (getline(list, item, ',')) {
+            // Whole item must be a number: reject things like "75abc" or ""
+            char* end = nullptr;
+            long percent = strtol(item.c_str(), &end, 10);
+            if (end == item.c_str() || *end != '\0' || percent <= 0 || percent > 100) {
+                cout << "Invalid percentage: '" << item << "'" << endl;
+                return -1;
+            }
+            percents.push_back(static_cast<int>(percent));
+        }
+
+        if (percents.empty()) {
+            cout << "Error: No output percentages given" << endl;
+            return -1;
+        }
+        sort(percents.rbegin(), percents.rend());
+        percents.erase(unique(percents.begin(), percents.end()), percents.end());
+
+        string prefix = argv[3];
+        int source_width = input.cols;
+        SeamCarver carver(std::move(input));
+        AsyncImageWriter writer;
+
+        for (int percent : percents) {
+            int target_width = max(1, source_width * percent / 100);
+
+            while (carver.getWidth() > target_width) {
+                vector<int> seam = carver.findVerticalSeamDP();
+                if (seam.empty()) {
+                    break;
+                }
+                carver.removeVerticalSeam(seam);
+            }
+
+            // A failed seam search would leave this and every later size too wide
+            if (carver.getWidth() != target_width) {
+                cout << "Error: Could not carve down to " << target_width << " columns for "
+                    << percent << "% (stuck at " << carver.getWidth() << ")" << endl;
+                writer.finish();
+                return -1;
+            }
+
+            // Queued outputs are the only extra copies kept alive
+            writer.enqueue(format("%s_%d.jpg", prefix.c_str(), percent), carver.getImage());
+        }
+
+        int failures = writer.finish();
+        cout << "Carved " << source_width - carver.getWidth() << " seams for "
+            << percents.size() << " output sizes ("
+            << carver.copyStats().frameCopies << " full-frame copies)" << endl;
+        return failures == 0 ? 0 : -1;
+    }
+
     cout << "Seam Carving - DP vs Greedy Algorithm Comparison" << endl;
     cout << "=================================================" << endl;
 
@@ -21,8 +237,10 @@ int main(int argc, char** argv) {
 
     cout << "Loaded image: " << original.cols << " x " << original.rows << endl;
 
-    // Create seam carver with the original image
-    Mat carved = original.clone();
+    // Create seam carver with its own copy of the original image; `carved`
+    // is refreshed from it after every change
+    SeamCarver carver(original.clone());
+    Mat carved = carver.imageView();
 
     // Algorithm mode: true = DP, false = Greedy
     bool use_dp = true;
@@ -34,6 +252,9 @@ int main(int argc, char** argv) {
     cout << "  1        - Show next VERTICAL seam (red)" << endl;
     cout << "  2        - Show next HORIZONTAL seam (green)" << endl;
     cout << "  E        - Show energy map" << endl;
+    cout << "  B        - Select a region to carve (drag a box, ENTER to confirm)" << endl;
+    cout << "  N        - Remove one VERTICAL seam inside the selected region" << endl;
+    cout << "  3        - Show next VERTICAL seam inside the selected region (red)" << endl;
     cout << "  R        - Reset to original" << endl;
     cout << "  S        - Save current carved image" << endl;
     cout << "  Q/ESC    - Quit" << endl;
@@ -51,6 +272,10 @@ int main(int argc, char** argv) {
     int vertical_seams_removed = 0;
     int horizontal_seams_removed = 0;
 
+    // Column band selected with 'B' for region-limited carving (-1 = none)
+    int band_start = -1;
+    int band_end = -1;
+
     while (true) {
         // Create side-by-side comparison
         Mat display;
@@ -110,7 +335,7 @@ int main(int argc, char** argv) {
 
         // Add controls at bottom
         int bottom_y = DISPLAY_HEIGHT - 30;
-        putText(display, "M: Toggle Algo | V/H: Remove seam | 1/2: Preview | E: Energy | R: Reset | S: Save | Q: Quit",
+        putText(display, "M: Toggle Algo | V/H: Remove seam | 1/2: Preview | E: Energy | B/N/3: Region | R: Reset | S: Save | Q: Quit",
             Point(20, bottom_y), FONT_HERSHEY_SIMPLEX, 0.5, Scalar(150, 150, 150), 1);
 
         imshow(WINDOW_NAME, display);
@@ -128,21 +353,26 @@ int main(int argc, char** argv) {
         }
         else if (key == ' ' || key == 'v' || key == 'V') {  // Remove vertical seam
             if (carved.cols > 1) {
-                SeamCarver temp_carver(carved);
                 vector<int> seam;
 
                 // Choose algorithm based on mode
                 if (use_dp) {
-                    seam = temp_carver.findVerticalSeamDP();
+                    seam = carver.findVerticalSeamDP();
                 }
                 else {
-                    seam = temp_carver.findVerticalSeamGreedy();
+                    seam = carver.findVerticalSeamGreedy();
                 }
 
                 if (!seam.empty()) {
-                    temp_carver.removeVerticalSeam(seam);
-                    carved = temp_carver.getImage();
+                    carver.removeVerticalSeam(seam);
+                    carved = carver.imageView();
                     vertical_seams_removed++;
+                    // The selected columns no longer line up with the image
+                    if (band_start >= 0) {
+                        band_start = -1;
+                        band_end = -1;
+                        cout << "Region selection cleared (full-frame seam removed)" << endl;
+                    }
 
                     string algo = use_dp ? "DP" : "Greedy";
                     cout << "Vertical seam removed using " << algo << "! New size: "
@@ -157,20 +387,19 @@ int main(int argc, char** argv) {
         }
         else if (key == 'h' || key == 'H') {  // Remove horizontal seam
             if (carved.rows > 1) {
-                SeamCarver temp_carver(carved);
                 vector<int> seam;
 
                 // Choose algorithm based on mode
                 if (use_dp) {
-                    seam = temp_carver.findHorizontalSeamDP();
+                    seam = carver.findHorizontalSeamDP();
                 }
                 else {
-                    seam = temp_carver.findHorizontalSeamGreedy();
+                    seam = carver.findHorizontalSeamGreedy();
                 }
 
                 if (!seam.empty()) {
-                    temp_carver.removeHorizontalSeam(seam);
-                    carved = temp_carver.getImage();
+                    carver.removeHorizontalSeam(seam);
+                    carved = carver.imageView();
                     horizontal_seams_removed++;
 
                     string algo = use_dp ? "DP" : "Greedy";
@@ -185,18 +414,17 @@ int main(int argc, char** argv) {
             }
         }
         else if (key == '1') {  // Visualize next vertical seam
-            SeamCarver temp_carver(carved);
             vector<int> seam;
 
             if (use_dp) {
-                seam = temp_carver.findVerticalSeamDP();
+                seam = carver.findVerticalSeamDP();
             }
             else {
-                seam = temp_carver.findVerticalSeamGreedy();
+                seam = carver.findVerticalSeamGreedy();
             }
 
             if (!seam.empty()) {
-                Mat seam_vis = temp_carver.visualizeVerticalSeam(seam, Scalar(0, 0, 255));
+                Mat seam_vis = carver.visualizeVerticalSeam(seam, Scalar(0, 0, 255));
 
                 string algo = use_dp ? "DP" : "Greedy";
                 string window_title = "Next VERTICAL Seam - " + algo + " (Red)";
@@ -208,18 +436,17 @@ int main(int argc, char** argv) {
             }
         }
         else if (key == '2') {  // Visualize next horizontal seam
-            SeamCarver temp_carver(carved);
             vector<int> seam;
 
             if (use_dp) {
-                seam = temp_carver.findHorizontalSeamDP();
+                seam = carver.findHorizontalSeamDP();
             }
             else {
-                seam = temp_carver.findHorizontalSeamGreedy();
+                seam = carver.findHorizontalSeamGreedy();
             }
 
             if (!seam.empty()) {
-                Mat seam_vis = temp_carver.visualizeHorizontalSeam(seam, Scalar(0, 255, 0));
+                Mat seam_vis = carver.visualizeHorizontalSeam(seam, Scalar(0, 255, 0));
 
                 string algo = use_dp ? "DP" : "Greedy";
                 string window_title = "Next HORIZONTAL Seam - " + algo + " (Green)";
@@ -231,8 +458,7 @@ int main(int argc, char** argv) {
             }
         }
         else if (key == 'e' || key == 'E') {  // Show energy map
-            SeamCarver temp_carver(carved);
-            Mat energy = temp_carver.getEnergyMap();
+            Mat energy = carver.energyView();
 
             // Normalize and apply colormap
             Mat energy_normalized;
@@ -249,10 +475,67 @@ int main(int argc, char** argv) {
 
             cout << "Energy map displayed (Blue=Low energy, Red=High energy)" << endl;
         }
+        else if (key == 'b' || key == 'B') {  // Select carving region
+            const string ROI_WINDOW = "Select Region (ENTER to confirm, C to cancel)";
+            Rect roi = selectROI(ROI_WINDOW, carved, false);
+            destroyWindow(ROI_WINDOW);
+
+            if (roi.width > 1) {
+                band_start = roi.x;
+                band_end = roi.x + roi.width;
+                cout << "Region selected: columns " << band_start << " to " << band_end - 1 << endl;
+            }
+            else {
+                band_start = -1;
+                band_end = -1;
+                cout << "Region selection cleared" << endl;
+            }
+        }
+        else if (key == '3') {  // Visualize next vertical seam inside region
+            if (band_start < 0) {
+                cout << "No region selected! Press B to select one first." << endl;
+            }
+            else {
+                vector<int> seam = carver.findVerticalSeamDP(band_start, band_end);
+
+                if (!seam.empty()) {
+                    Mat seam_vis = carver.visualizeVerticalSeam(seam, Scalar(0, 0, 255));
+
+                    string window_title = "Next VERTICAL Seam in Region - DP (Red)";
+                    namedWindow(window_title, WINDOW_NORMAL);
+                    resizeWindow(window_title, 600, 500);
+                    imshow(window_title, seam_vis);
+
+                    cout << "Showing next VERTICAL seam inside region (red)" << endl;
+                }
+            }
+        }
+        else if (key == 'n' || key == 'N') {  // Remove vertical seam inside region
+            if (band_start < 0) {
+                cout << "No region selected! Press B to select one first." << endl;
+            }
+            else if (band_end - band_start <= 1) {
+                cout << "Region too narrow to remove more vertical seams!" << endl;
+            }
+            else {
+                if (carver.carveVerticalSeamsInRange(band_start, band_end, 1) == 1) {
+                    carved = carver.imageView();
+                    band_end--;
+                    vertical_seams_removed++;
+
+                    cout << "Vertical seam removed inside region! New size: "
+                        << carved.cols << "x" << carved.rows
+                        << " (region: " << band_end - band_start << " cols)" << endl;
+                }
+            }
+        }
         else if (key == 'r' || key == 'R') {  // Reset
-            carved = original.clone();
+            carver = SeamCarver(original.clone());
+            carved = carver.imageView();
             vertical_seams_removed = 0;
             horizontal_seams_removed = 0;
+            band_start = -1;
+            band_end = -1;
             cout << "Reset to original image" << endl;
         }
         else if (key == 's' || key == 'S') {  // Save
@@ -269,5 +552,10 @@ int main(int argc, char** argv) {
     cout << "Algorithm used: " << (use_dp ? "Dynamic Programming" : "Greedy") << endl;
     cout << "Vertical seams removed: " << vertical_seams_removed << endl;
     cout << "Horizontal seams removed: " << horizontal_seams_removed << endl;
+
+    // One copy per removed seam is expected (the removal itself)
+    const SeamCarver::CopyStats& stats = carver.copyStats();
+    cout << "Full-frame copies since last reset: " << stats.frameCopies
+        << " for " << stats.seamsRemoved << " seams" << endl;
     return 0;
 }